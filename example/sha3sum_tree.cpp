@@ -0,0 +1,23 @@
+#include "../picosha3_tree.h"
+#include <iostream>
+
+// Usage: sha3sum_tree <path> [<cache file>]
+// The cache file should live outside of <path>, otherwise it is hashed too.
+int main(int argc, char const *argv[]) {
+    if(argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <path> [<cache file>]"
+                  << std::endl;
+        return 1;
+    }
+    try {
+        picosha3::DigestCache<512> cache{argc > 2 ? argv[2] : ""};
+        picosha3::TreeHasher<512> tree_hasher{cache};
+        std::cout << tree_hasher.get_hex_string(argv[1]) << "  " << argv[1]
+                  << std::endl;
+        cache.save();
+    } catch(const std::exception& e) {
+        std::cerr << argv[0] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
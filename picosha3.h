@@ -1,11 +1,19 @@
 #ifndef PICOSHA3_H
 #define PICOSHA3_H
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
+#include <map>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace picosha3 {
     constexpr size_t bits_to_bytes(size_t bits) { return bits / 8; };
@@ -41,20 +49,26 @@ namespace picosha3 {
         }
     };
 
+    // Rotation offsets of rho, indexed as A[x][y].
+    constexpr static size_t rho_offsets[5][5] = {{0, 36, 3, 41, 18},
+                                                 {1, 44, 10, 45, 2},
+                                                 {62, 6, 43, 15, 61},
+                                                 {28, 55, 25, 21, 56},
+                                                 {27, 20, 39, 8, 14}};
+
     inline void rho(state_t& A) {
-        size_t x{1};
-        size_t y{0};
-        for(size_t t = 0; t < 24; ++t) {
-            size_t offset = ((t + 1) * (t + 2) / 2) % 64;
-            A[x][y] = (A[x][y] << offset) | (A[x][y] >> (64 - offset));
-            size_t tmp{y};
-            y = (2 * x + 3 * y) % 5;
-            x = tmp;
-        };
+        for(size_t x = 0; x < 5; ++x) {
+            for(size_t y = 0; y < 5; ++y) {
+                const auto offset = rho_offsets[x][y];
+                if(offset != 0) {
+                    A[x][y] = (A[x][y] << offset) | (A[x][y] >> (64 - offset));
+                }
+            }
+        }
     };
 
     inline void pi(state_t& A) {
-        state_t tmp{A};
+        const state_t tmp{A};
         for(size_t x = 0; x < 5; ++x) {
             for(size_t y = 0; y < 5; ++y) {
                 A[x][y] = tmp[(x + 3 * y) % 5][x];
@@ -63,11 +77,11 @@ namespace picosha3 {
     };
 
     inline void chi(state_t& A) {
-        state_t tmp{A};
-        for(size_t x = 0; x < 5; ++x) {
-            for(size_t y = 0; y < 5; ++y) {
-                A[x][y] =
-                  tmp[x][y] ^ (~(tmp[(x + 1) % 5][y]) & tmp[(x + 2) % 5][y]);
+        for(size_t y = 0; y < 5; ++y) {
+            const uint64_t row[5] = {A[0][y], A[1][y], A[2][y], A[3][y],
+                                     A[4][y]};
+            for(size_t x = 0; x < 5; ++x) {
+                A[x][y] = row[x] ^ (~row[(x + 1) % 5] & row[(x + 2) % 5]);
             }
         }
     };
@@ -145,6 +159,7 @@ namespace picosha3 {
     enum class PaddingType {
         SHA,
         SHAKE,
+        CSHAKE,
     };
 
     template <typename InIter>
@@ -167,7 +182,7 @@ namespace picosha3 {
     class HashGenerator {
     public:
         HashGenerator()
-          : buffer_{}, buffer_pos_{buffer_.begin()}, A_{}, hash_{},
+          : buffer_{}, buffer_pos_{0}, A_{}, hash_{},
             is_finished_{false} {}
 
         void clear() {
@@ -183,8 +198,8 @@ namespace picosha3 {
               "The size of input iterator value_type must be one byte.");
 
             for(; first != last; ++first) {
-                *buffer_pos_ = *first;
-                if(++buffer_pos_ == buffer_.end()) {
+                buffer_[buffer_pos_] = *first;
+                if(++buffer_pos_ == buffer_.size()) {
                     absorb(buffer_, A_);
                     keccak_p(A_);
                     clear_buffer();
@@ -287,7 +302,7 @@ namespace picosha3 {
     private:
         void clear_buffer() {
             buffer_.fill(0);
-            buffer_pos_ = buffer_.begin();
+            buffer_pos_ = 0;
         };
 
         void clear_state() {
@@ -297,21 +312,27 @@ namespace picosha3 {
         };
 
         void add_padding() {
-            const auto q =
-              buffer_.size() - std::distance(buffer_pos_, buffer_.begin());
+            const auto q = buffer_.size() - buffer_pos_;
 
             if(padding_type == PaddingType::SHA) {
                 if(q == 1) {
-                    *buffer_pos_ = 0x86;
+                    buffer_[buffer_pos_] = 0x86;
                 } else {
-                    *buffer_pos_ = 0x06;
+                    buffer_[buffer_pos_] = 0x06;
                     buffer_.back() = 0x80;
                 }
             } else if(padding_type == PaddingType::SHAKE) {
                 if(q == 1) {
-                    *buffer_pos_ = 0x9F;
+                    buffer_[buffer_pos_] = 0x9F;
+                } else {
+                    buffer_[buffer_pos_] = 0x1F;
+                    buffer_.back() = 0x80;
+                }
+            } else if(padding_type == PaddingType::CSHAKE) {
+                if(q == 1) {
+                    buffer_[buffer_pos_] = 0x84;
                 } else {
-                    *buffer_pos_ = 0x1F;
+                    buffer_[buffer_pos_] = 0x04;
                     buffer_.back() = 0x80;
                 }
             }
@@ -328,7 +349,7 @@ namespace picosha3 {
         };
 
         std::array<byte_t, rate_bytes> buffer_;
-        typename decltype(buffer_)::iterator buffer_pos_;
+        size_t buffer_pos_;
         state_t A_;
         std::array<byte_t, d_bytes> hash_;
         bool is_finished_;
@@ -356,6 +377,514 @@ namespace picosha3 {
         return HashGenerator<rate_bytes, d_bytes, PaddingType::SHAKE>{};
     }
 
+    // Integer encodings of NIST SP 800-185, at most 8 bytes of value.
+    struct EncodedInteger {
+        byte_t bytes[9];
+        size_t size;
+
+        constexpr const byte_t* cbegin() const { return bytes; }
+        constexpr const byte_t* cend() const { return bytes + size; }
+    };
+
+    constexpr size_t encoded_integer_bytes(uint64_t x) {
+        size_t n = 1;
+        for(x >>= 8; x != 0; x >>= 8) {
+            ++n;
+        }
+        return n;
+    }
+
+    constexpr EncodedInteger left_encode(uint64_t x) {
+        const auto n = encoded_integer_bytes(x);
+        EncodedInteger encoded{{}, n + 1};
+        encoded.bytes[0] = static_cast<byte_t>(n);
+        for(size_t i = 0; i < n; ++i) {
+            encoded.bytes[n - i] = static_cast<byte_t>(x >> (8 * i));
+        }
+        return encoded;
+    }
+
+    constexpr EncodedInteger right_encode(uint64_t x) {
+        const auto n = encoded_integer_bytes(x);
+        EncodedInteger encoded{{}, n + 1};
+        for(size_t i = 0; i < n; ++i) {
+            encoded.bytes[n - 1 - i] = static_cast<byte_t>(x >> (8 * i));
+        }
+        encoded.bytes[n] = static_cast<byte_t>(n);
+        return encoded;
+    }
+
+    // A non-owning view of size bytes starting at data.
+    class Span {
+    public:
+        Span(const void* data, size_t size)
+          : data_{static_cast<const byte_t*>(data)}, size_{size} {}
+
+        const byte_t* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const byte_t* data_;
+        size_t size_;
+    };
+
+    // process_field() absorbs encode_string(field) of NIST SP 800-185,
+    // that is left_encode of the field length in bits followed by the field
+    // bytes. Integers are absorbed as sizeof(T) bytes in big-endian order.
+    // A char array is a string literal: its last element must be the
+    // terminating NUL, which is not absorbed. A char pointer must point to a
+    // NUL-terminated string; pass raw char buffers as a Span. The length
+    // prefix of integers, std::array and char arrays is a compile time
+    // constant.
+    template <typename Generator, typename T>
+    auto process_field(Generator& generator, const T& field)
+      -> std::enable_if_t<std::is_integral<T>::value> {
+        constexpr auto prefix = left_encode(sizeof(T) * 8);
+        byte_t bytes[sizeof(T)] = {};
+        for(size_t i = 0; i < sizeof(T); ++i) {
+            bytes[i] = static_cast<byte_t>(static_cast<uint64_t>(field) >>
+                                           (8 * (sizeof(T) - 1 - i)));
+        }
+        generator.process(prefix.cbegin(), prefix.cend());
+        generator.process(bytes, bytes + sizeof(T));
+    }
+
+    template <typename Generator, typename T, size_t N>
+    void process_field(Generator& generator, const std::array<T, N>& field) {
+        static_assert(sizeof(T) == 1,
+                      "The size of field value_type must be one byte.");
+        constexpr auto prefix = left_encode(N * 8);
+        generator.process(prefix.cbegin(), prefix.cend());
+        generator.process(field.cbegin(), field.cend());
+    }
+
+    template <typename Generator, typename InContainer>
+    auto process_field(Generator& generator, const InContainer& field)
+      -> decltype(field.data(), field.size(), void()) {
+        const auto prefix = left_encode(field.size() * 8);
+        generator.process(prefix.cbegin(), prefix.cend());
+        generator.process(field.data(), field.data() + field.size());
+    }
+
+    template <typename Generator, size_t N>
+    void process_field(Generator& generator, const char (&field)[N]) {
+        static_assert(N > 0, "A char array field must hold a NUL.");
+        if(field[N - 1] != '\0') {
+            throw std::runtime_error("Char array field is not NUL-terminated!");
+        }
+        constexpr auto prefix = left_encode((N - 1) * 8);
+        generator.process(prefix.cbegin(), prefix.cend());
+        generator.process(field, field + N - 1);
+    }
+
+    // Takes char pointers only, so that char arrays do not decay to it.
+    template <typename Generator, typename T>
+    auto process_field(Generator& generator, const T& field)
+      -> std::enable_if_t<std::is_same<T, const char*>::value ||
+                          std::is_same<T, char*>::value> {
+        const auto size = std::strlen(field);
+        const auto prefix = left_encode(size * 8);
+        generator.process(prefix.cbegin(), prefix.cend());
+        generator.process(field, field + size);
+    }
+
+    // cSHAKE of NIST SP 800-185 with a non-empty function name N. The state
+    // after absorbing bytepad(encode_string(N) || encode_string(S), rate) is
+    // kept, so clear() does not absorb the prefix again.
+    template <size_t rate_bytes, size_t d_bytes>
+    class CShakeGenerator {
+    public:
+        CShakeGenerator(const std::string& function_name,
+                        const std::string& customization)
+          : generator_{}, initial_{} {
+            if(function_name.empty()) {
+                throw std::runtime_error("Function name must not be empty!");
+            }
+            constexpr auto rate = left_encode(rate_bytes);
+            generator_.process(rate.cbegin(), rate.cend());
+            process_field(generator_, function_name);
+            process_field(generator_, customization);
+
+            const auto written =
+              rate.size + left_encode(function_name.size() * 8).size +
+              function_name.size() +
+              left_encode(customization.size() * 8).size +
+              customization.size();
+            const std::array<byte_t, rate_bytes> zeros{};
+            generator_.process(zeros.cbegin(),
+                               zeros.cbegin() +
+                                 (rate_bytes - written % rate_bytes) %
+                                   rate_bytes);
+            initial_ = generator_;
+        }
+
+        void clear() { generator_ = initial_; }
+
+        template <typename InIter>
+        void process(InIter first, InIter last) {
+            generator_.process(first, last);
+        }
+
+        void finish() { generator_.finish(); }
+
+        template <typename OutIter>
+        void get_hash_bytes(OutIter first, OutIter last) {
+            generator_.get_hash_bytes(first, last);
+        }
+
+        template <typename OutCotainer>
+        void get_hash_bytes(OutCotainer& dest) {
+            generator_.get_hash_bytes(dest);
+        }
+
+        std::string get_hex_string() { return generator_.get_hex_string(); }
+
+    private:
+        HashGenerator<rate_bytes, d_bytes, PaddingType::CSHAKE> generator_;
+        HashGenerator<rate_bytes, d_bytes, PaddingType::CSHAKE> initial_;
+    };
+
+    // TupleHash of NIST SP 800-185. Each field is absorbed with its length,
+    // so that distinct tuples never collide by concatenation.
+    template <size_t rate_bytes, size_t d_bytes>
+    class TupleHashGenerator {
+    public:
+        explicit TupleHashGenerator(const std::string& customization)
+          : generator_{"TupleHash", customization} {}
+
+        void clear() { generator_.clear(); }
+
+        template <typename... Fields>
+        void process_fields(const Fields&... fields) {
+            using expand = int[];
+            (void)expand{0, (process_field(generator_, fields), 0)...};
+        }
+
+        void finish() {
+            constexpr auto length = right_encode(d_bytes * 8);
+            generator_.process(length.cbegin(), length.cend());
+            generator_.finish();
+        }
+
+        template <typename OutIter>
+        void get_hash_bytes(OutIter first, OutIter last) {
+            generator_.get_hash_bytes(first, last);
+        }
+
+        template <typename OutCotainer>
+        void get_hash_bytes(OutCotainer& dest) {
+            generator_.get_hash_bytes(dest);
+        }
+
+        std::string get_hex_string() { return generator_.get_hex_string(); }
+
+        template <typename... Fields>
+        std::array<byte_t, d_bytes> hash_fields(const Fields&... fields) {
+            process_fields(fields...);
+            finish();
+            std::array<byte_t, d_bytes> hash{};
+            generator_.get_hash_bytes(hash);
+            clear();
+            return hash;
+        }
+
+    private:
+        CShakeGenerator<rate_bytes, d_bytes> generator_;
+    };
+
+    template <size_t strength_bits, size_t d_bits>
+    auto get_tuplehash_generator(const std::string& customization = "") {
+        static_assert(strength_bits == 128 or strength_bits == 256,
+                      "TupleHash only accepts strength 128 or 256 bits.");
+        constexpr auto strength_bytes = bits_to_bytes(strength_bits);
+        constexpr auto capacity_bytes = strength_bytes * 2;
+        constexpr auto rate_bytes = b_bytes - capacity_bytes;
+        constexpr auto d_bytes = bits_to_bytes(d_bits);
+        return TupleHashGenerator<rate_bytes, d_bytes>{customization};
+    }
+
+    // Chaining values of the ParallelHash blocks of the input bytes
+    // [offset, offset + size). offset is a multiple of block_size, and so is
+    // size unless the range ends the input. serialize() gives a portable
+    // byte string for sending the result to another process.
+    template <size_t cv_bytes>
+    struct ParallelHashPartial {
+        uint64_t block_size;
+        uint64_t offset;
+        uint64_t size;
+        std::vector<std::array<byte_t, cv_bytes>> chaining_values;
+
+        std::string serialize() const {
+            std::string bytes{magic};
+            for(const auto value : {static_cast<uint64_t>(cv_bytes),
+                                    block_size, offset, size,
+                                    static_cast<uint64_t>(
+                                      chaining_values.size())}) {
+                for(size_t i = 0; i < 8; ++i) {
+                    bytes.push_back(static_cast<char>(value >> (8 * i)));
+                }
+            }
+            for(const auto& cv : chaining_values) {
+                bytes.append(cv.cbegin(), cv.cend());
+            }
+            return bytes;
+        }
+
+        static ParallelHashPartial deserialize(const std::string& bytes) {
+            const size_t header_bytes = sizeof(magic) - 1 + 5 * 8;
+            if(bytes.size() < header_bytes ||
+               bytes.compare(0, sizeof(magic) - 1, magic) != 0) {
+                throw std::runtime_error("Malformed partial hash!");
+            }
+            uint64_t values[5] = {};
+            for(size_t k = 0; k < 5; ++k) {
+                for(size_t i = 0; i < 8; ++i) {
+                    const auto byte = static_cast<byte_t>(
+                      bytes[sizeof(magic) - 1 + 8 * k + i]);
+                    values[k] |= static_cast<uint64_t>(byte) << (8 * i);
+                }
+            }
+            const auto count = values[4];
+            if(values[0] != cv_bytes ||
+               (bytes.size() - header_bytes) / cv_bytes != count ||
+               (bytes.size() - header_bytes) % cv_bytes != 0) {
+                throw std::runtime_error("Malformed partial hash!");
+            }
+            ParallelHashPartial partial{values[1], values[2], values[3], {}};
+            partial.chaining_values.resize(count);
+            auto first = bytes.cbegin() + header_bytes;
+            for(auto& cv : partial.chaining_values) {
+                std::copy(first, first + cv_bytes, cv.begin());
+                first += cv_bytes;
+            }
+            return partial;
+        }
+
+    private:
+        constexpr static const char magic[] = "PSHA3PH1";
+    };
+
+    template <size_t cv_bytes>
+    constexpr const char ParallelHashPartial<cv_bytes>::magic[];
+
+    // Worker side of ParallelHash: hashes the input range starting at offset
+    // into a ParallelHashPartial.
+    template <size_t rate_bytes, size_t cv_bytes>
+    class ParallelHashLeafGenerator {
+    public:
+        using partial_t = ParallelHashPartial<cv_bytes>;
+
+        ParallelHashLeafGenerator(uint64_t block_size, uint64_t offset)
+          : generator_{}, partial_{block_size, offset, 0, {}}, block_pos_{0},
+            is_finished_{false} {
+            if(block_size == 0 || offset % block_size != 0) {
+                throw std::runtime_error(
+                  "Offset must be a multiple of the block size!");
+            }
+        }
+
+        template <typename InIter>
+        void process(InIter first, InIter last) {
+            static_assert(
+              sizeof(typename std::iterator_traits<InIter>::value_type) == 1,
+              "The size of input iterator value_type must be one byte.");
+
+            process_(first, last,
+                     typename std::iterator_traits<InIter>::iterator_category{});
+        }
+
+        void finish() {
+            if(block_pos_ != 0) {
+                finish_block();
+            }
+            is_finished_ = true;
+        }
+
+        const partial_t& get_partial() const {
+            if(!is_finished_) {
+                throw std::runtime_error("Not finished!");
+            }
+            return partial_;
+        }
+
+    private:
+        // Each slice ends at a block boundary or at the end of the input.
+        template <typename InIter>
+        void process_(InIter first, InIter last,
+                      std::random_access_iterator_tag) {
+            while(first != last) {
+                const auto length = std::min<uint64_t>(
+                  last - first, partial_.block_size - block_pos_);
+                const auto slice_last = first + length;
+                generator_.process(first, slice_last);
+                process_slice(length);
+                first = slice_last;
+            }
+        }
+
+        // Other iterators are copied into a chunk first.
+        template <typename InIter>
+        void process_(InIter first, InIter last, std::input_iterator_tag) {
+            std::array<byte_t, 4096> chunk;
+            while(first != last) {
+                const auto max_length = std::min<uint64_t>(
+                  chunk.size(), partial_.block_size - block_pos_);
+                uint64_t length = 0;
+                for(; first != last && length < max_length; ++first) {
+                    chunk[length++] = static_cast<byte_t>(*first);
+                }
+                generator_.process(chunk.cbegin(), chunk.cbegin() + length);
+                process_slice(length);
+            }
+        }
+
+        void process_slice(uint64_t length) {
+            partial_.size += length;
+            block_pos_ += length;
+            if(block_pos_ == partial_.block_size) {
+                finish_block();
+            }
+        }
+
+        void finish_block() {
+            generator_.finish();
+            std::array<byte_t, cv_bytes> cv{};
+            generator_.get_hash_bytes(cv);
+            generator_.clear();
+            partial_.chaining_values.push_back(cv);
+            block_pos_ = 0;
+        }
+
+        HashGenerator<rate_bytes, cv_bytes, PaddingType::SHAKE> generator_;
+        partial_t partial_;
+        uint64_t block_pos_;
+        bool is_finished_;
+    };
+
+    // Coordinator side of ParallelHash of NIST SP 800-185. Partial results
+    // may be merged in any order; finish() requires that they cover the
+    // whole input exactly once.
+    template <size_t rate_bytes, size_t cv_bytes, size_t d_bytes>
+    class ParallelHashGenerator {
+    public:
+        using partial_t = ParallelHashPartial<cv_bytes>;
+
+        ParallelHashGenerator(uint64_t block_size, uint64_t total_size,
+                              const std::string& customization)
+          : generator_{"ParallelHash", customization},
+            block_size_{block_size}, total_size_{total_size}, partials_{} {
+            if(block_size_ == 0) {
+                throw std::runtime_error("Block size must not be zero!");
+            }
+        }
+
+        void clear() {
+            generator_.clear();
+            partials_.clear();
+        }
+
+        void merge(const partial_t& partial) {
+            const auto end = partial.offset + partial.size;
+            if(partial.block_size != block_size_ ||
+               partial.offset % block_size_ != 0 || end < partial.offset ||
+               end > total_size_ ||
+               (end != total_size_ && partial.size % block_size_ != 0) ||
+               partial.chaining_values.size() !=
+                 (partial.size + block_size_ - 1) / block_size_) {
+                throw std::runtime_error("Partial hash does not fit!");
+            }
+            if(partial.size == 0) {
+                return;
+            }
+            const auto next = partials_.lower_bound(partial.offset);
+            if((next != partials_.end() && next->first < end) ||
+               (next != partials_.begin() &&
+                std::prev(next)->second.offset +
+                    std::prev(next)->second.size >
+                  partial.offset)) {
+                throw std::runtime_error("Partial hashes overlap!");
+            }
+            partials_.emplace_hint(next, partial.offset, partial);
+        }
+
+        void merge(const std::string& serialized_partial) {
+            merge(partial_t::deserialize(serialized_partial));
+        }
+
+        void finish() {
+            uint64_t covered = 0;
+            uint64_t count = 0;
+            for(const auto& item : partials_) {
+                if(item.first != covered) {
+                    break;
+                }
+                covered += item.second.size;
+                count += item.second.chaining_values.size();
+            }
+            if(covered != total_size_) {
+                throw std::runtime_error("Partial hashes are missing!");
+            }
+
+            const auto block_size = left_encode(block_size_);
+            generator_.process(block_size.cbegin(), block_size.cend());
+            for(const auto& item : partials_) {
+                for(const auto& cv : item.second.chaining_values) {
+                    generator_.process(cv.cbegin(), cv.cend());
+                }
+            }
+            const auto block_count = right_encode(count);
+            generator_.process(block_count.cbegin(), block_count.cend());
+            constexpr auto length = right_encode(d_bytes * 8);
+            generator_.process(length.cbegin(), length.cend());
+            generator_.finish();
+        }
+
+        template <typename OutIter>
+        void get_hash_bytes(OutIter first, OutIter last) {
+            generator_.get_hash_bytes(first, last);
+        }
+
+        template <typename OutCotainer>
+        void get_hash_bytes(OutCotainer& dest) {
+            generator_.get_hash_bytes(dest);
+        }
+
+        std::string get_hex_string() { return generator_.get_hex_string(); }
+
+    private:
+        CShakeGenerator<rate_bytes, d_bytes> generator_;
+        uint64_t block_size_;
+        uint64_t total_size_;
+        std::map<uint64_t, partial_t> partials_;
+    };
+
+    template <size_t strength_bits>
+    auto get_parallelhash_leaf_generator(uint64_t block_size,
+                                         uint64_t offset) {
+        static_assert(strength_bits == 128 or strength_bits == 256,
+                      "ParallelHash only accepts strength 128 or 256 bits.");
+        constexpr auto strength_bytes = bits_to_bytes(strength_bits);
+        constexpr auto capacity_bytes = strength_bytes * 2;
+        constexpr auto rate_bytes = b_bytes - capacity_bytes;
+        constexpr auto cv_bytes = strength_bytes * 2;
+        return ParallelHashLeafGenerator<rate_bytes, cv_bytes>{block_size,
+                                                               offset};
+    }
+
+    template <size_t strength_bits, size_t d_bits>
+    auto get_parallelhash_generator(uint64_t block_size, uint64_t total_size,
+                                    const std::string& customization = "") {
+        static_assert(strength_bits == 128 or strength_bits == 256,
+                      "ParallelHash only accepts strength 128 or 256 bits.");
+        constexpr auto strength_bytes = bits_to_bytes(strength_bits);
+        constexpr auto capacity_bytes = strength_bytes * 2;
+        constexpr auto rate_bytes = b_bytes - capacity_bytes;
+        constexpr auto cv_bytes = strength_bytes * 2;
+        constexpr auto d_bytes = bits_to_bytes(d_bits);
+        return ParallelHashGenerator<rate_bytes, cv_bytes, d_bytes>{
+          block_size, total_size, customization};
+    }
+
 } // namespace picosha3
 
 #endif
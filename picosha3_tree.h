@@ -0,0 +1,749 @@
+#ifndef PICOSHA3_TREE_H
+#define PICOSHA3_TREE_H
+
+#include "picosha3.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace picosha3 {
+    // Identity of a file's contents as seen by the file system. Any change
+    // of these fields is treated as a change of the contents.
+    struct FileKey {
+        uint64_t dev;
+        uint64_t ino;
+        uint64_t size;
+        uint64_t mtime_ns;
+        uint64_t ctime_ns;
+    };
+
+    inline bool operator==(const FileKey& lhs, const FileKey& rhs) {
+        return std::tie(lhs.dev, lhs.ino, lhs.size, lhs.mtime_ns,
+                        lhs.ctime_ns) == std::tie(rhs.dev, rhs.ino, rhs.size,
+                                                  rhs.mtime_ns, rhs.ctime_ns);
+    }
+
+    inline bool operator<(const FileKey& lhs, const FileKey& rhs) {
+        return std::tie(lhs.dev, lhs.ino, lhs.size, lhs.mtime_ns,
+                        lhs.ctime_ns) < std::tie(rhs.dev, rhs.ino, rhs.size,
+                                                 rhs.mtime_ns, rhs.ctime_ns);
+    }
+
+    inline FileKey make_file_key(const struct stat& st) {
+#if defined(__APPLE__)
+        const auto& mtime = st.st_mtimespec;
+        const auto& ctime = st.st_ctimespec;
+#else
+        const auto& mtime = st.st_mtim;
+        const auto& ctime = st.st_ctim;
+#endif
+        return FileKey{
+          static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino),
+          static_cast<uint64_t>(st.st_size),
+          static_cast<uint64_t>(mtime.tv_sec) * 1000000000ull +
+            static_cast<uint64_t>(mtime.tv_nsec),
+          static_cast<uint64_t>(ctime.tv_sec) * 1000000000ull +
+            static_cast<uint64_t>(ctime.tv_nsec)};
+    }
+
+    // On-disk map from FileKey to digest.
+    //
+    // The file is a 32 byte header ("PSHA3TC2", digest size, entry count,
+    // save count) followed by fixed size records (key, save count when last
+    // seen, digest) sorted by key, all in host byte order. It is
+    // memory-mapped read-only and searched in place, so opening a large
+    // cache costs nothing until it is used.
+    //
+    // save() merges the entries inserted or erased since construction into
+    // the mapped ones, so several trees can share a cache. A mapped entry is
+    // dropped when an entry for the same (dev, ino) was inserted or erased,
+    // or when it was last seen more than max_age_runs saves ago. find()
+    // reports entries older than half of that, which the caller inserts
+    // again to keep them.
+    template <size_t d_bits>
+    class DigestCache {
+    public:
+        constexpr static size_t d_bytes = bits_to_bytes(d_bits);
+        using digest_t = std::array<byte_t, d_bytes>;
+
+        // An empty path gives a cache that is never loaded nor saved.
+        explicit DigestCache(std::string path, uint64_t max_age_runs = 16)
+          : path_{std::move(path)}, max_age_runs_{max_age_runs},
+            map_{nullptr}, map_size_{0}, count_{0}, run_{0}, entries_{} {
+            load();
+        }
+
+        DigestCache(const DigestCache&) = delete;
+        DigestCache& operator=(const DigestCache&) = delete;
+
+        ~DigestCache() { unmap(); }
+
+        // Number of entries in the loaded cache file.
+        size_t size() const { return count_; }
+
+        bool find(const FileKey& key, digest_t& digest) const {
+            bool is_aging;
+            return find(key, digest, is_aging);
+        }
+
+        bool find(const FileKey& key, digest_t& digest,
+                  bool& is_aging) const {
+            size_t first = 0;
+            size_t last = count_;
+            while(first < last) {
+                const auto mid = first + (last - first) / 2;
+                const auto record = record_at(mid);
+                const auto mid_key = read_key(record);
+                if(mid_key < key) {
+                    first = mid + 1;
+                } else if(key < mid_key) {
+                    last = mid;
+                } else {
+                    std::copy(record + key_bytes + seen_bytes,
+                              record + record_bytes, digest.begin());
+                    is_aging = age(read_raw<uint64_t>(record + key_bytes)) >
+                               max_age_runs_ / 2;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void insert(const FileKey& key, const digest_t& digest) {
+            entries_.push_back(Entry{key, digest, true});
+        }
+
+        // Forgets any digest of the file identified by key.dev and key.ino.
+        void erase(const FileKey& key) {
+            entries_.push_back(Entry{key, digest_t{}, false});
+        }
+
+        // Does nothing unless an entry was inserted or erased. The cache is
+        // written to a unique temporary file and renamed over path, so
+        // concurrent savers never mix their records, but the last one wins.
+        void save() {
+            if(path_.empty() || entries_.empty()) {
+                return;
+            }
+            // For equal keys, the last inserted or erased entry wins.
+            std::stable_sort(entries_.begin(), entries_.end());
+            std::vector<Entry> entries;
+            for(auto& entry : entries_) {
+                if(!entries.empty() && entries.back().key == entry.key) {
+                    entries.back() = entry;
+                } else {
+                    entries.push_back(entry);
+                }
+            }
+            entries_.swap(entries);
+
+            // Mapped records are kept unless their file has an entry or they
+            // are too old.
+            std::vector<bool> kept(count_);
+            uint64_t count = 0;
+            auto entry = entries_.cbegin();
+            for(size_t i = 0; i < count_; ++i) {
+                const auto key = read_key(record_at(i));
+                while(entry != entries_.cend() &&
+                      std::tie(entry->key.dev, entry->key.ino) <
+                        std::tie(key.dev, key.ino)) {
+                    ++entry;
+                }
+                kept[i] = (entry == entries_.cend() ||
+                           std::tie(entry->key.dev, entry->key.ino) !=
+                             std::tie(key.dev, key.ino)) &&
+                          age(read_raw<uint64_t>(record_at(i) + key_bytes)) <=
+                            max_age_runs_;
+                count += kept[i] ? 1 : 0;
+            }
+            for(const auto& e : entries_) {
+                count += e.is_valid ? 1 : 0;
+            }
+
+            std::string tmp_path = path_ + ".XXXXXX";
+            const int fd = ::mkstemp(&tmp_path[0]);
+            if(fd < 0) {
+                throw std::runtime_error("Cannot write " + tmp_path);
+            }
+            try {
+                const uint64_t run = run_ + 1;
+                Writer writer{fd, tmp_path, run, {}};
+                const uint32_t digest_size = d_bytes;
+                const uint32_t reserved = 0;
+                writer.write(magic, sizeof(magic) - 1);
+                writer.write_raw(digest_size);
+                writer.write_raw(reserved);
+                writer.write_raw(count);
+                writer.write_raw(run);
+
+                entry = entries_.cbegin();
+                for(size_t i = 0; i <= count_; ++i) {
+                    const bool is_end = i == count_;
+                    if(!is_end && !kept[i]) {
+                        continue;
+                    }
+                    const auto record = is_end ? nullptr : record_at(i);
+                    for(; entry != entries_.cend() &&
+                          (is_end || entry->key < read_key(record));
+                        ++entry) {
+                        if(entry->is_valid) {
+                            writer.write_entry(*entry);
+                        }
+                    }
+                    if(!is_end) {
+                        writer.write(record, record_bytes);
+                    }
+                }
+                writer.flush();
+                if(::fchmod(fd, cache_mode()) != 0 || ::fsync(fd) != 0) {
+                    throw std::runtime_error("Cannot write " + tmp_path);
+                }
+            } catch(...) {
+                ::close(fd);
+                ::unlink(tmp_path.c_str());
+                throw;
+            }
+            if(::close(fd) != 0 ||
+               ::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+                ::unlink(tmp_path.c_str());
+                throw std::runtime_error("Cannot rename " + tmp_path);
+            }
+        }
+
+    private:
+        // mkstemp creates 0600 files. The cache keeps the mode of the file
+        // it replaces, or gets the mode a newly created file would have.
+        mode_t cache_mode() const {
+            struct stat st;
+            if(::stat(path_.c_str(), &st) == 0) {
+                return st.st_mode & 07777;
+            }
+            const auto mask = ::umask(0);
+            ::umask(mask);
+            return 0666 & ~mask;
+        }
+
+        struct Entry {
+            FileKey key;
+            digest_t digest;
+            bool is_valid;
+
+            bool operator<(const Entry& rhs) const { return key < rhs.key; }
+        };
+
+        struct Writer {
+            int fd;
+            const std::string& path;
+            uint64_t run;
+            std::string buffer;
+
+            void write(const void* data, size_t size) {
+                buffer.append(static_cast<const char*>(data), size);
+                if(buffer.size() >= (1 << 20)) {
+                    flush();
+                }
+            }
+
+            template <typename T>
+            void write_raw(const T& value) {
+                write(&value, sizeof(value));
+            }
+
+            void write_entry(const Entry& entry) {
+                write_raw(entry.key.dev);
+                write_raw(entry.key.ino);
+                write_raw(entry.key.size);
+                write_raw(entry.key.mtime_ns);
+                write_raw(entry.key.ctime_ns);
+                write_raw(run);
+                write(entry.digest.data(), entry.digest.size());
+            }
+
+            void flush() {
+                size_t written = 0;
+                while(written < buffer.size()) {
+                    const auto length = ::write(fd, buffer.data() + written,
+                                                buffer.size() - written);
+                    if(length < 0) {
+                        throw std::runtime_error("Cannot write " + path);
+                    }
+                    written += static_cast<size_t>(length);
+                }
+                buffer.clear();
+            }
+        };
+
+        constexpr static const char magic[] = "PSHA3TC2";
+        constexpr static size_t header_bytes = 32;
+        constexpr static size_t key_bytes = 5 * sizeof(uint64_t);
+        constexpr static size_t seen_bytes = sizeof(uint64_t);
+        constexpr static size_t record_bytes = key_bytes + seen_bytes + d_bytes;
+
+        // Number of saves since an entry last seen in run seen, counting the
+        // next save.
+        uint64_t age(uint64_t seen) const {
+            return run_ + 1 > seen ? run_ + 1 - seen : 0;
+        }
+
+        template <typename T>
+        static T read_raw(const byte_t* p) {
+            T value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        static FileKey read_key(const byte_t* p) {
+            return FileKey{read_raw<uint64_t>(p), read_raw<uint64_t>(p + 8),
+                           read_raw<uint64_t>(p + 16),
+                           read_raw<uint64_t>(p + 24),
+                           read_raw<uint64_t>(p + 32)};
+        }
+
+        const byte_t* record_at(size_t index) const {
+            return map_ + header_bytes + index * record_bytes;
+        }
+
+        // A missing or malformed cache is treated as empty.
+        void load() {
+            if(path_.empty()) {
+                return;
+            }
+            const int fd = ::open(path_.c_str(), O_RDONLY);
+            if(fd < 0) {
+                return;
+            }
+            struct stat st;
+            if(::fstat(fd, &st) != 0 ||
+               static_cast<size_t>(st.st_size) < header_bytes) {
+                ::close(fd);
+                return;
+            }
+            const auto size = static_cast<size_t>(st.st_size);
+            void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if(p == MAP_FAILED) {
+                return;
+            }
+            map_ = static_cast<const byte_t*>(p);
+            map_size_ = size;
+
+            const auto digest_size = read_raw<uint32_t>(map_ + 8);
+            const auto count = read_raw<uint64_t>(map_ + 16);
+            if(std::memcmp(map_, magic, sizeof(magic) - 1) != 0 ||
+               digest_size != d_bytes ||
+               count != (size - header_bytes) / record_bytes ||
+               (size - header_bytes) % record_bytes != 0) {
+                unmap();
+                return;
+            }
+            count_ = count;
+            run_ = read_raw<uint64_t>(map_ + 24);
+        }
+
+        void unmap() {
+            if(map_ != nullptr) {
+                ::munmap(const_cast<byte_t*>(map_), map_size_);
+            }
+            map_ = nullptr;
+            map_size_ = 0;
+            count_ = 0;
+            run_ = 0;
+        }
+
+        std::string path_;
+        uint64_t max_age_runs_;
+        const byte_t* map_;
+        size_t map_size_;
+        size_t count_;
+        uint64_t run_;
+        std::vector<Entry> entries_;
+    };
+
+    template <size_t d_bits>
+    constexpr const char DigestCache<d_bits>::magic[];
+
+    // Hashes a file or a directory tree.
+    //
+    // A regular file's digest is the SHA3 of its contents, a symbolic link's
+    // digest is the SHA3 of its target path. A directory's digest is the
+    // SHA3 of its children sorted by name, each one contributing a type tag
+    // ('f', 'l' or 'd'), the name length as a little-endian 64 bit integer,
+    // the name and the child's digest. Other file types are ignored.
+    //
+    // Regular files found in the cache are not read, and those found in an
+    // aging entry are inserted again. The rest are hashed and inserted into
+    // the cache, which the caller saves. Directories are read
+    // and hashed one level at a time, each level by num_threads threads.
+    //
+    // A file whose mtime or ctime is later than racy_margin before the start
+    // of the run is hashed but not cached: with coarse file system
+    // timestamps, rewriting it right after it was read may not change its
+    // key.
+    template <size_t d_bits>
+    class TreeHasher {
+    public:
+        using digest_t = typename DigestCache<d_bits>::digest_t;
+
+        explicit TreeHasher(
+          DigestCache<d_bits>& cache, size_t num_threads = 0,
+          std::chrono::nanoseconds racy_margin = std::chrono::seconds(2))
+          : cache_(cache), num_threads_{num_threads},
+            racy_margin_{racy_margin}, racy_ns_{0}, nodes_{}, misses_{},
+            hits_{0} {
+            if(num_threads_ == 0) {
+                num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+            }
+        }
+
+        digest_t operator()(const std::string& root) {
+            nodes_.clear();
+            misses_.clear();
+            hits_ = 0;
+            racy_ns_ = static_cast<uint64_t>(
+              (std::chrono::system_clock::now().time_since_epoch() -
+               racy_margin_)
+                .count());
+
+            struct stat st;
+            if(::stat(root.c_str(), &st) != 0) {
+                throw std::runtime_error("File not found: " + root);
+            }
+            Node node{};
+            if(!make_node(root, root, st, node)) {
+                throw std::runtime_error("Not a file nor a directory: " +
+                                         root);
+            }
+            std::vector<Directory> level;
+            add_node(std::move(node), root, level);
+
+            std::vector<std::vector<size_t>> levels;
+            while(!level.empty()) {
+                levels.emplace_back();
+                for(const auto& directory : level) {
+                    levels.back().push_back(directory.node);
+                }
+                level = add_directories(level);
+            }
+            hash_misses();
+            for(auto it = levels.crbegin(); it != levels.crend(); ++it) {
+                hash_directories(*it);
+            }
+            if(nodes_.front().is_vanished) {
+                throw std::runtime_error("File not found: " + root);
+            }
+
+            for(const auto& node : nodes_) {
+                if(node.is_cached && node.is_aging && !node.is_vanished) {
+                    cache_.insert(node.key, node.digest);
+                }
+            }
+            for(const auto& miss : misses_) {
+                const auto& miss_node = nodes_[miss.node];
+                if(miss_node.is_vanished) {
+                    continue;
+                }
+                if(miss_node.is_cacheable) {
+                    cache_.insert(miss_node.key, miss_node.digest);
+                } else {
+                    cache_.erase(miss_node.key);
+                }
+            }
+            return nodes_.front().digest;
+        }
+
+        std::string get_hex_string(const std::string& root) {
+            return bytes_to_hex_string(operator()(root));
+        }
+
+        size_t hit_count() const { return hits_; }
+        size_t miss_count() const { return misses_.size(); }
+
+    private:
+        struct Node {
+            char type;
+            bool is_cached;
+            bool is_aging;
+            bool is_cacheable;
+            bool is_vanished;
+            FileKey key;
+            digest_t digest;
+            std::string name;
+            std::vector<size_t> children;
+        };
+
+        struct Directory {
+            size_t node;
+            std::string path;
+        };
+
+        struct Miss {
+            size_t node;
+            std::string path;
+        };
+
+        // Joins the started threads even if starting another one throws.
+        struct ThreadJoiner {
+            std::vector<std::thread>& threads;
+
+            ~ThreadJoiner() {
+                for(auto& thread : threads) {
+                    if(thread.joinable()) {
+                        thread.join();
+                    }
+                }
+            }
+        };
+
+        // Calls a copy of function per thread for each index below count.
+        template <typename Function>
+        void parallel_for(size_t count, const Function& function) {
+            std::atomic<size_t> next{0};
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            auto worker = [&]() {
+                auto f = function;
+                for(size_t i; (i = next++) < count;) {
+                    try {
+                        f(i);
+                    } catch(...) {
+                        std::lock_guard<std::mutex> lock{error_mutex};
+                        if(!error) {
+                            error = std::current_exception();
+                        }
+                        next = count;
+                    }
+                }
+            };
+
+            std::vector<std::thread> threads;
+            {
+                ThreadJoiner joiner{threads};
+                const auto num_threads = std::min(num_threads_, count);
+                for(size_t i = 1; i < num_threads; ++i) {
+                    threads.emplace_back(worker);
+                }
+                worker();
+            }
+            if(error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        // Files of a live tree may be removed or replaced while it is hashed.
+        static bool is_vanished_error(int error) {
+            return error == ENOENT || error == ENOTDIR;
+        }
+
+        // Fills node from st. Returns false for unsupported file types and
+        // for links removed since st was read.
+        bool make_node(const std::string& path, const std::string& name,
+                       const struct stat& st, Node& node) const {
+            node.key = make_file_key(st);
+            node.name = name;
+            if(S_ISREG(st.st_mode)) {
+                node.type = 'f';
+                node.is_cached =
+                  cache_.find(node.key, node.digest, node.is_aging);
+            } else if(S_ISLNK(st.st_mode)) {
+                node.type = 'l';
+                std::string target(static_cast<size_t>(st.st_size) + 1, '\0');
+                const auto length =
+                  ::readlink(path.c_str(), &target[0], target.size());
+                if(length < 0) {
+                    if(is_vanished_error(errno) || errno == EINVAL) {
+                        return false;
+                    }
+                    throw std::runtime_error("Cannot read link: " + path);
+                }
+                target.resize(static_cast<size_t>(length));
+                auto generator = get_sha3_generator<d_bits>();
+                generator(target, node.digest);
+            } else if(S_ISDIR(st.st_mode)) {
+                node.type = 'd';
+            } else {
+                return false;
+            }
+            return true;
+        }
+
+        // Children are always pushed after their parent.
+        void add_node(Node&& node, const std::string& path,
+                      std::vector<Directory>& next_level) {
+            const auto index = nodes_.size();
+            if(node.type == 'd') {
+                next_level.push_back(Directory{index, path});
+            } else if(node.type == 'f') {
+                if(node.is_cached) {
+                    ++hits_;
+                } else {
+                    misses_.push_back(Miss{index, path});
+                }
+            }
+            nodes_.push_back(std::move(node));
+        }
+
+        std::vector<Directory>
+        add_directories(const std::vector<Directory>& level) {
+            std::vector<std::vector<Node>> children(level.size());
+            std::vector<char> is_vanished(level.size());
+            parallel_for(level.size(),
+                         [this, &level, &children, &is_vanished](size_t i) {
+                             is_vanished[i] =
+                               !read_directory(level[i].path, children[i]);
+                         });
+
+            std::vector<Directory> next_level;
+            for(size_t i = 0; i < level.size(); ++i) {
+                nodes_[level[i].node].is_vanished = is_vanished[i] != 0;
+                for(auto& child : children[i]) {
+                    nodes_[level[i].node].children.push_back(nodes_.size());
+                    const auto path = level[i].path + "/" + child.name;
+                    add_node(std::move(child), path, next_level);
+                }
+            }
+            return next_level;
+        }
+
+        // Returns false if the directory no longer exists. Entries removed
+        // while it is read are skipped.
+        bool read_directory(const std::string& path,
+                            std::vector<Node>& children) const {
+            DIR* dir = ::opendir(path.c_str());
+            if(dir == nullptr) {
+                if(is_vanished_error(errno)) {
+                    return false;
+                }
+                throw std::runtime_error("Cannot open directory: " + path);
+            }
+            std::vector<std::string> names;
+            while(const auto entry = ::readdir(dir)) {
+                if(std::strcmp(entry->d_name, ".") != 0 &&
+                   std::strcmp(entry->d_name, "..") != 0) {
+                    names.emplace_back(entry->d_name);
+                }
+            }
+            ::closedir(dir);
+            std::sort(names.begin(), names.end());
+
+            children.reserve(names.size());
+            for(const auto& name : names) {
+                const auto child_path = path + "/" + name;
+                struct stat st;
+                if(::lstat(child_path.c_str(), &st) != 0) {
+                    if(is_vanished_error(errno)) {
+                        continue;
+                    }
+                    throw std::runtime_error("Cannot stat file: " +
+                                             child_path);
+                }
+                Node child{};
+                if(make_node(child_path, name, st, child)) {
+                    children.push_back(std::move(child));
+                }
+            }
+            return true;
+        }
+
+        void hash_misses() {
+            parallel_for(misses_.size(),
+                         [this, generator = get_sha3_generator<d_bits>(),
+                          block = std::vector<byte_t>(1 << 16)](
+                           size_t i) mutable {
+                             hash_file(misses_[i].path,
+                                       nodes_[misses_[i].node], generator,
+                                       block);
+                         });
+        }
+
+        // A file modified while being read is hashed but not cached, since
+        // its digest may not match either version of the contents. A file
+        // removed since the walk is left out of its directory's digest.
+        template <typename Generator>
+        void hash_file(const std::string& path, Node& node,
+                       Generator& generator, std::vector<byte_t>& block) {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if(fd < 0) {
+                if(is_vanished_error(errno)) {
+                    node.is_vanished = true;
+                    return;
+                }
+                throw std::runtime_error("Cannot open file: " + path);
+            }
+            ssize_t length;
+            while((length = ::read(fd, block.data(), block.size())) > 0) {
+                generator.process(block.data(), block.data() + length);
+            }
+            struct stat st;
+            const bool ok = length == 0 && ::fstat(fd, &st) == 0;
+            ::close(fd);
+            if(!ok) {
+                generator.clear();
+                throw std::runtime_error("Cannot read file: " + path);
+            }
+            generator.finish();
+            generator.get_hash_bytes(node.digest);
+            generator.clear();
+            node.is_cacheable = make_file_key(st) == node.key &&
+                                node.key.mtime_ns < racy_ns_ &&
+                                node.key.ctime_ns < racy_ns_;
+        }
+
+        void hash_directories(const std::vector<size_t>& level) {
+            parallel_for(level.size(),
+                         [this, &level,
+                          generator = get_sha3_generator<d_bits>()](
+                           size_t i) mutable {
+                             hash_directory(nodes_[level[i]], generator);
+                         });
+        }
+
+        template <typename Generator>
+        void hash_directory(Node& node, Generator& generator) {
+            for(const auto child_index : node.children) {
+                const auto& child = nodes_[child_index];
+                if(child.is_vanished) {
+                    continue;
+                }
+                std::array<byte_t, 9> header{};
+                header[0] = static_cast<byte_t>(child.type);
+                uint64_t length = child.name.size();
+                for(size_t k = 1; k < header.size(); ++k, length >>= 8) {
+                    header[k] = static_cast<byte_t>(length & 0xFF);
+                }
+                generator.process(header.cbegin(), header.cend());
+                generator.process(child.name.cbegin(), child.name.cend());
+                generator.process(child.digest.cbegin(), child.digest.cend());
+            }
+            generator.finish();
+            generator.get_hash_bytes(node.digest);
+            generator.clear();
+        }
+
+        DigestCache<d_bits>& cache_;
+        size_t num_threads_;
+        std::chrono::nanoseconds racy_margin_;
+        uint64_t racy_ns_;
+        std::vector<Node> nodes_;
+        std::vector<Miss> misses_;
+        size_t hits_;
+    };
+
+} // namespace picosha3
+
+#endif
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../picosha3.h"
+
+namespace picosha3 {
+    namespace {
+        std::vector<byte_t> nist_sample() {
+            return {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+                    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27};
+        }
+
+        std::vector<byte_t> long_sample() {
+            std::vector<byte_t> target(10000);
+            for(size_t i = 0; i < target.size(); ++i) {
+                target[i] = static_cast<byte_t>((i * 7) % 251);
+            }
+            return target;
+        }
+
+        template <size_t strength_bits, typename InContainer>
+        std::string hash_range(const InContainer& src, uint64_t block_size,
+                               uint64_t first, uint64_t last) {
+            auto leaf_generator =
+              get_parallelhash_leaf_generator<strength_bits>(block_size,
+                                                             first);
+            leaf_generator.process(src.cbegin() + first, src.cbegin() + last);
+            leaf_generator.finish();
+            return leaf_generator.get_partial().serialize();
+        }
+    } // namespace
+
+    TEST(TestParallelHash128, NistSample) {
+        auto target = nist_sample();
+        std::string correct_hash =
+          "ba8dc1d1d979331d3f813603c67f72609ab5e44b94a0b8f9af46514454a2b4f5";
+        auto hash_generator =
+          get_parallelhash_generator<128, 256>(8, target.size());
+        hash_generator.merge(hash_range<128>(target, 8, 0, target.size()));
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+    }
+    TEST(TestParallelHash128, Customization) {
+        auto target = nist_sample();
+        std::string correct_hash =
+          "fc484dcb3f84dceedc353438151bee58157d6efed0445a81f165e495795b7206";
+        auto hash_generator = get_parallelhash_generator<128, 256>(
+          8, target.size(), "Parallel Data");
+        hash_generator.merge(hash_range<128>(target, 8, 16, 24));
+        hash_generator.merge(hash_range<128>(target, 8, 0, 16));
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+    }
+    TEST(TestParallelHash128, EmptyString) {
+        std::string correct_hash =
+          "96427c30224408859f95e89e4fa84e1c7a1478dbf2008ac982ce61a77f37a272";
+        auto hash_generator = get_parallelhash_generator<128, 256>(8, 0);
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+    }
+
+    TEST(TestParallelHash256, NistSample) {
+        auto target = nist_sample();
+        std::string correct_hash =
+          "bc1ef124da34495e948ead207dd9842235da432d2bbc54b4c110e64c451105531b7f"
+          "2a3e0ce055c02805e7c2de1fb746af97a1dd01f43b824e31b87612410429";
+        auto hash_generator =
+          get_parallelhash_generator<256, 512>(8, target.size());
+        hash_generator.merge(hash_range<256>(target, 8, 8, 24));
+        hash_generator.merge(hash_range<256>(target, 8, 0, 8));
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+    }
+    TEST(TestParallelHash256, WorkerProcesses) {
+        const auto target = long_sample();
+        const uint64_t block_size = 1024;
+        const uint64_t ranges[][2] = {
+          {0, 3072}, {3072, 4096}, {4096, 8192}, {8192, 10000}};
+        std::string correct_hash =
+          "06a8d05212378fcc2ca363a4aa118e4431b5a988a504ae65a2f8db3f754d57eb06b4"
+          "7c9472af08072f720f9031e04ccdf390c4680dc412b3dcd51fcf3b6b4e19";
+
+        std::vector<int> fds;
+        std::vector<pid_t> pids;
+        for(const auto& range : ranges) {
+            int fd[2];
+            ASSERT_EQ(0, ::pipe(fd));
+            const auto pid = ::fork();
+            ASSERT_GE(pid, 0);
+            if(pid == 0) {
+                ::close(fd[0]);
+                const auto partial =
+                  hash_range<256>(target, block_size, range[0], range[1]);
+                const auto written =
+                  ::write(fd[1], partial.data(), partial.size());
+                ::_exit(written == static_cast<ssize_t>(partial.size()) ? 0
+                                                                         : 1);
+            }
+            ::close(fd[1]);
+            fds.push_back(fd[0]);
+            pids.push_back(pid);
+        }
+
+        auto hash_generator =
+          get_parallelhash_generator<256, 512>(block_size, target.size());
+        for(auto fd = fds.rbegin(); fd != fds.rend(); ++fd) {
+            std::string partial;
+            char buffer[4096];
+            ssize_t length;
+            while((length = ::read(*fd, buffer, sizeof(buffer))) > 0) {
+                partial.append(buffer, length);
+            }
+            ::close(*fd);
+            hash_generator.merge(partial);
+        }
+        for(const auto pid : pids) {
+            int status = 0;
+            ASSERT_EQ(pid, ::waitpid(pid, &status, 0));
+            EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+    }
+    TEST(TestParallelHash256, PiecewiseAndSequentialInput) {
+        const auto target = long_sample();
+        std::string correct_hash =
+          "06a8d05212378fcc2ca363a4aa118e4431b5a988a504ae65a2f8db3f754d57eb06b4"
+          "7c9472af08072f720f9031e04ccdf390c4680dc412b3dcd51fcf3b6b4e19";
+
+        auto leaf_generator = get_parallelhash_leaf_generator<256>(1024, 0);
+        for(size_t first = 0; first < target.size(); first += 1000) {
+            const auto last = std::min<size_t>(first + 1000, target.size());
+            leaf_generator.process(target.cbegin() + first,
+                                   target.cbegin() + last);
+        }
+        leaf_generator.finish();
+        auto hash_generator =
+          get_parallelhash_generator<256, 512>(1024, target.size());
+        hash_generator.merge(leaf_generator.get_partial());
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+
+        std::istringstream iss{std::string(target.cbegin(), target.cend())};
+        auto stream_leaf_generator =
+          get_parallelhash_leaf_generator<256>(1024, 0);
+        stream_leaf_generator.process(std::istreambuf_iterator<char>(iss),
+                                      std::istreambuf_iterator<char>());
+        stream_leaf_generator.finish();
+        hash_generator.clear();
+        hash_generator.merge(stream_leaf_generator.get_partial());
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+
+        const std::list<byte_t> list(target.cbegin(), target.cend());
+        auto list_leaf_generator = get_parallelhash_leaf_generator<256>(1024, 0);
+        list_leaf_generator.process(list.cbegin(), list.cend());
+        list_leaf_generator.finish();
+        hash_generator.clear();
+        hash_generator.merge(list_leaf_generator.get_partial());
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+    }
+    TEST(TestParallelHash256, MissingPartial) {
+        const auto target = long_sample();
+        auto hash_generator =
+          get_parallelhash_generator<256, 512>(1024, target.size());
+        hash_generator.merge(hash_range<256>(target, 1024, 0, 4096));
+        hash_generator.merge(hash_range<256>(target, 1024, 8192, 10000));
+        EXPECT_THROW(hash_generator.finish(), std::runtime_error);
+    }
+    TEST(TestParallelHash256, OverlappingPartial) {
+        const auto target = long_sample();
+        auto hash_generator =
+          get_parallelhash_generator<256, 512>(1024, target.size());
+        hash_generator.merge(hash_range<256>(target, 1024, 2048, 4096));
+        EXPECT_THROW(
+          hash_generator.merge(hash_range<256>(target, 1024, 0, 3072)),
+          std::runtime_error);
+        EXPECT_THROW(
+          hash_generator.merge(hash_range<256>(target, 1024, 3072, 5120)),
+          std::runtime_error);
+    }
+    TEST(TestParallelHash256, MisalignedPartial) {
+        const auto target = long_sample();
+        auto hash_generator =
+          get_parallelhash_generator<256, 512>(1024, target.size());
+        EXPECT_THROW(
+          hash_generator.merge(hash_range<256>(target, 1024, 0, 1000)),
+          std::runtime_error);
+        EXPECT_THROW(hash_generator.merge(hash_range<128>(target, 1024, 0,
+                                                          1024)),
+                     std::runtime_error);
+        EXPECT_THROW(get_parallelhash_leaf_generator<256>(1024, 1000),
+                     std::runtime_error);
+    }
+
+} // namespace picosha3
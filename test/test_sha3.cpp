@@ -1,4 +1,5 @@
 #include <fstream>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -42,6 +43,13 @@ namespace picosha3 {
         auto hash_generator = get_sha3_generator<256>();
         EXPECT_EQ(correct_hash, hash_generator.get_hex_string(target));
     }
+    TEST(Test256, OneByteShortOfRate) {
+        std::string target(135, 'a');
+        std::string correct_hash =
+          "8094bb53c44cfb1e67b7c30447f9a1c33696d2463ecc1d9c92538913392843c9";
+        auto hash_generator = get_sha3_generator<256>();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string(target));
+    }
 
     TEST(Test384, EmptyString) {
         std::string target = "";
@@ -133,6 +141,14 @@ namespace picosha3 {
         auto hash_generator = get_shake_generator<128, 512>();
         EXPECT_EQ(correct_hash, hash_generator.get_hex_string(target));
     }
+    TEST(TestSHAKE128, OneByteShortOfRate) {
+        std::string target(167, 'a');
+        std::string correct_hash =
+          "4f5c6c53ae8190a8ff8a55b2125d28703052d10278570960c2066a905d916c345cd4"
+          "4d8a367360c0a03da17ba8c8801afb7b7a047b0e2ea86fc81f76e8623720";
+        auto hash_generator = get_shake_generator<128, 512>();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string(target));
+    }
 
     TEST(TestSHAKE256, EmptyString) {
         std::string target = "";
@@ -185,4 +201,76 @@ namespace picosha3 {
         EXPECT_EQ(correct_hash, hash_generator.get_hex_string(target));
     }
 
+    TEST(TestTupleHash128, TwoFields) {
+        std::array<byte_t, 3> x0{{0x00, 0x01, 0x02}};
+        std::vector<byte_t> x1{0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
+        std::string correct_hash =
+          "c5d8786c1afb9b82111ab34b65b2c0048fa64e6d48e263264ce1707d3ffc8ed1";
+        auto hash_generator = get_tuplehash_generator<128, 256>();
+        EXPECT_EQ(correct_hash,
+                  bytes_to_hex_string(hash_generator.hash_fields(x0, x1)));
+    }
+    TEST(TestTupleHash128, Customization) {
+        std::array<byte_t, 3> x0{{0x00, 0x01, 0x02}};
+        std::vector<byte_t> x1{0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
+        std::string correct_hash =
+          "75cdb20ff4db1154e841d758e24160c54bae86eb8c13e7f5f40eb35588e96dfb";
+        auto hash_generator = get_tuplehash_generator<128, 256>("My Tuple App");
+        EXPECT_EQ(correct_hash,
+                  bytes_to_hex_string(hash_generator.hash_fields(x0, x1)));
+    }
+    TEST(TestTupleHash128, ThreeFields) {
+        std::array<byte_t, 3> x0{{0x00, 0x01, 0x02}};
+        std::vector<byte_t> x1{0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
+        std::vector<byte_t> x2{0x20, 0x21, 0x22, 0x23, 0x24,
+                               0x25, 0x26, 0x27, 0x28};
+        std::string correct_hash =
+          "e60f202c89a2631eda8d4c588ca5fd07f39e5151998deccf973adb3804bb6e84";
+        auto hash_generator = get_tuplehash_generator<128, 256>("My Tuple App");
+        hash_generator.process_fields(x0, x1);
+        hash_generator.process_fields(x2);
+        hash_generator.finish();
+        EXPECT_EQ(correct_hash, hash_generator.get_hex_string());
+    }
+
+    TEST(TestTupleHash256, TwoFields) {
+        std::array<byte_t, 3> x0{{0x00, 0x01, 0x02}};
+        std::vector<byte_t> x1{0x10, 0x11, 0x12, 0x13, 0x14, 0x15};
+        std::string correct_hash =
+          "cfb7058caca5e668f81a12a20a2195ce97a925f1dba3e7449a56f82201ec607311ac"
+          "2696b1ab5ea2352df1423bde7bd4bb78c9aed1a853c78672f9eb23bbe194";
+        auto hash_generator = get_tuplehash_generator<256, 512>();
+        EXPECT_EQ(correct_hash,
+                  bytes_to_hex_string(hash_generator.hash_fields(x0, x1)));
+    }
+    TEST(TestTupleHash256, MixedFields) {
+        const byte_t payload[] = {0x00, 0x01, 0x02};
+        std::string correct_hash =
+          "fb1864b6d5cad7f107aa93220716c4968f2a5bfcd9134fe27946d2939ea9bb912fa7"
+          "df0ba233976c2d4aa7f8aa9e822e12df47d731e1095cd1fa1bad6ac4b211";
+        auto hash_generator = get_tuplehash_generator<256, 512>();
+        EXPECT_EQ(correct_hash,
+                  bytes_to_hex_string(hash_generator.hash_fields(
+                    "tenant", uint64_t{1}, Span(payload, sizeof(payload)))));
+        EXPECT_EQ(correct_hash,
+                  bytes_to_hex_string(hash_generator.hash_fields(
+                    std::string{"tenant"}, uint64_t{1},
+                    Span(payload, sizeof(payload)))));
+    }
+    TEST(TestTupleHash256, FieldBoundaries) {
+        auto hash_generator = get_tuplehash_generator<256, 512>();
+        EXPECT_NE(hash_generator.hash_fields("ab", "c"),
+                  hash_generator.hash_fields("a", "bc"));
+    }
+    TEST(TestTupleHash256, CharFields) {
+        auto hash_generator = get_tuplehash_generator<256, 512>();
+        const auto hash = hash_generator.hash_fields(std::string{"abc"});
+        const char* pointer = "abc";
+        const char fixed[3] = {'a', 'b', 'c'};
+        EXPECT_EQ(hash, hash_generator.hash_fields("abc"));
+        EXPECT_EQ(hash, hash_generator.hash_fields(pointer));
+        EXPECT_EQ(hash, hash_generator.hash_fields(Span(fixed, sizeof(fixed))));
+        EXPECT_THROW(hash_generator.hash_fields(fixed), std::runtime_error);
+    }
+
 } // namespace picosha3
@@ -0,0 +1,256 @@
+#include <cstdlib>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "../picosha3_tree.h"
+
+namespace picosha3 {
+    class TreeHasherTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            char tmpl[] = "/tmp/picosha3_tree_XXXXXX";
+            ASSERT_NE(nullptr, ::mkdtemp(tmpl));
+            dir_ = tmpl;
+            root_ = dir_ + "/root";
+            cache_path_ = dir_ + "/cache";
+            ::mkdir(root_.c_str(), 0700);
+            ::mkdir((root_ + "/sub").c_str(), 0700);
+            write(root_ + "/a.txt", "a");
+            write(root_ + "/sub/b.txt", "Hello, world!");
+        }
+
+        void TearDown() override {
+            const auto command = "rm -rf " + dir_;
+            EXPECT_EQ(0, std::system(command.c_str()));
+        }
+
+        static void write(const std::string& path, const std::string& text) {
+            std::ofstream ofs{path, std::ios::binary | std::ios::trunc};
+            ofs << text;
+        }
+
+        std::string dir_;
+        std::string root_;
+        std::string cache_path_;
+    };
+
+    TEST_F(TreeHasherTest, SingleFile) {
+        std::string correct_hash =
+          "80084bf2fba02475726feb2cab2d8215eab14bc6bdd8bfb2c8151257032ecd8b";
+        DigestCache<256> cache{""};
+        TreeHasher<256> tree_hasher{cache};
+        EXPECT_EQ(correct_hash, tree_hasher.get_hex_string(root_ + "/a.txt"));
+    }
+
+    TEST_F(TreeHasherTest, Deterministic) {
+        DigestCache<256> cache{""};
+        TreeHasher<256> tree_hasher{cache, 1};
+        const auto hash = tree_hasher.get_hex_string(root_);
+
+        DigestCache<256> other_cache{""};
+        TreeHasher<256> other_tree_hasher{other_cache, 4};
+        EXPECT_EQ(hash, other_tree_hasher.get_hex_string(root_));
+    }
+
+    TEST_F(TreeHasherTest, NamesAreHashed) {
+        DigestCache<256> cache{""};
+        TreeHasher<256> tree_hasher{cache};
+        const auto hash = tree_hasher.get_hex_string(root_);
+        ::rename((root_ + "/a.txt").c_str(), (root_ + "/c.txt").c_str());
+        EXPECT_NE(hash, tree_hasher.get_hex_string(root_));
+    }
+
+    TEST_F(TreeHasherTest, FilesRemovedDuringRun) {
+        DigestCache<256> cache{""};
+        TreeHasher<256> tree_hasher{cache, 4};
+        const auto hash = tree_hasher.get_hex_string(root_);
+
+        const auto many = root_ + "/many";
+        ::mkdir(many.c_str(), 0700);
+        for(size_t i = 0; i < 20; ++i) {
+            const auto dir = many + "/" + std::to_string(i);
+            ::mkdir(dir.c_str(), 0700);
+            for(size_t j = 0; j < 100; ++j) {
+                write(dir + "/" + std::to_string(j), std::to_string(i * j));
+                ::symlink("target", (dir + "/l" + std::to_string(j)).c_str());
+            }
+        }
+
+        std::atomic<bool> is_removed{false};
+        std::thread remover{[&]() {
+            const auto command = "rm -rf " + many;
+            EXPECT_EQ(0, std::system(command.c_str()));
+            is_removed = true;
+        }};
+        while(!is_removed) {
+            EXPECT_NO_THROW(tree_hasher(root_));
+        }
+        remover.join();
+        EXPECT_EQ(hash, tree_hasher.get_hex_string(root_));
+    }
+
+    TEST_F(TreeHasherTest, CacheHitAndMiss) {
+        const auto no_margin = std::chrono::nanoseconds::zero();
+        std::string hash;
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            hash = tree_hasher.get_hex_string(root_);
+            EXPECT_EQ(0u, tree_hasher.hit_count());
+            EXPECT_EQ(2u, tree_hasher.miss_count());
+            cache.save();
+        }
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            EXPECT_EQ(hash, tree_hasher.get_hex_string(root_));
+            EXPECT_EQ(2u, tree_hasher.hit_count());
+            EXPECT_EQ(0u, tree_hasher.miss_count());
+            cache.save();
+        }
+        write(root_ + "/sub/b.txt", "Hello, World!!");
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            EXPECT_NE(hash, tree_hasher.get_hex_string(root_));
+            EXPECT_EQ(1u, tree_hasher.hit_count());
+            EXPECT_EQ(1u, tree_hasher.miss_count());
+        }
+    }
+
+    TEST_F(TreeHasherTest, RacyFilesAreNotCached) {
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, std::chrono::hours(1)};
+            tree_hasher(root_);
+            cache.save();
+        }
+        DigestCache<256> cache{cache_path_};
+        TreeHasher<256> tree_hasher{cache};
+        tree_hasher(root_);
+        EXPECT_EQ(0u, tree_hasher.hit_count());
+        EXPECT_EQ(2u, tree_hasher.miss_count());
+    }
+
+    TEST_F(TreeHasherTest, CacheIsSharedBetweenTrees) {
+        const auto no_margin = std::chrono::nanoseconds::zero();
+        const auto other_root = dir_ + "/other";
+        ::mkdir(other_root.c_str(), 0700);
+        write(other_root + "/c.txt", "c");
+        for(const auto& root : {root_, other_root, root_}) {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root);
+            cache.save();
+        }
+        DigestCache<256> cache{cache_path_};
+        TreeHasher<256> tree_hasher{cache, 0, no_margin};
+        tree_hasher(other_root);
+        EXPECT_EQ(1u, tree_hasher.hit_count());
+        tree_hasher(root_);
+        EXPECT_EQ(2u, tree_hasher.hit_count());
+    }
+
+    TEST_F(TreeHasherTest, ReplacedFilesAreEvicted) {
+        const auto no_margin = std::chrono::nanoseconds::zero();
+        const uint64_t max_age_runs = 2;
+        for(size_t i = 0; i < 8; ++i) {
+            // Links outside the tree keep replaced inodes from being reused.
+            const auto old_path = dir_ + "/a.old" + std::to_string(i);
+            ASSERT_EQ(0, ::link((root_ + "/a.txt").c_str(), old_path.c_str()));
+            const auto tmp_path = dir_ + "/a.tmp";
+            write(tmp_path, "a" + std::to_string(i));
+            ASSERT_EQ(0, ::rename(tmp_path.c_str(), (root_ + "/a.txt").c_str()));
+            DigestCache<256> cache{cache_path_, max_age_runs};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root_);
+            cache.save();
+        }
+        // sub/b.txt and the last max_age_runs + 1 versions of a.txt at most.
+        DigestCache<256> cache{cache_path_, max_age_runs};
+        EXPECT_LE(cache.size(), 1 + max_age_runs + 1);
+
+        TreeHasher<256> tree_hasher{cache, 0, no_margin};
+        tree_hasher(root_);
+        EXPECT_EQ(2u, tree_hasher.hit_count());
+    }
+
+    TEST_F(TreeHasherTest, VisitedEntriesAreKept) {
+        const auto no_margin = std::chrono::nanoseconds::zero();
+        const uint64_t max_age_runs = 2;
+        for(size_t i = 0; i < 8; ++i) {
+            write(root_ + "/a.txt", std::string(i + 1, 'a'));
+            DigestCache<256> cache{cache_path_, max_age_runs};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root_ + "/a.txt");
+            tree_hasher(root_ + "/sub");
+            if(i > 0) {
+                EXPECT_EQ(1u, tree_hasher.hit_count());
+            }
+            cache.save();
+        }
+    }
+
+    TEST_F(TreeHasherTest, CleanCacheIsNotRewritten) {
+        const auto no_margin = std::chrono::nanoseconds::zero();
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root_);
+            cache.save();
+        }
+        struct stat before;
+        ASSERT_EQ(0, ::stat(cache_path_.c_str(), &before));
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root_);
+            cache.save();
+        }
+        struct stat after;
+        ASSERT_EQ(0, ::stat(cache_path_.c_str(), &after));
+        EXPECT_EQ(before.st_ino, after.st_ino);
+    }
+
+    TEST_F(TreeHasherTest, CacheFileMode) {
+        const auto no_margin = std::chrono::nanoseconds::zero();
+        const auto mask = ::umask(022);
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root_);
+            cache.save();
+        }
+        ::umask(mask);
+        struct stat st;
+        ASSERT_EQ(0, ::stat(cache_path_.c_str(), &st));
+        EXPECT_EQ(0644u, st.st_mode & 07777);
+
+        ASSERT_EQ(0, ::chmod(cache_path_.c_str(), 0664));
+        write(root_ + "/a.txt", "aa");
+        {
+            DigestCache<256> cache{cache_path_};
+            TreeHasher<256> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root_);
+            cache.save();
+        }
+        ASSERT_EQ(0, ::stat(cache_path_.c_str(), &st));
+        EXPECT_EQ(0664u, st.st_mode & 07777);
+    }
+
+    TEST_F(TreeHasherTest, CacheOfOtherDigestSizeIsIgnored) {
+        const auto no_margin = std::chrono::nanoseconds::zero();
+        {
+            DigestCache<512> cache{cache_path_};
+            TreeHasher<512> tree_hasher{cache, 0, no_margin};
+            tree_hasher(root_);
+            cache.save();
+        }
+        DigestCache<256> cache{cache_path_};
+        TreeHasher<256> tree_hasher{cache, 0, no_margin};
+        tree_hasher(root_);
+        EXPECT_EQ(0u, tree_hasher.hit_count());
+    }
+
+} // namespace picosha3